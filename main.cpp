@@ -1,6 +1,20 @@
 #include "virtual_vec.h"
-
+#include "virtual_soa.h"
+#include "virtual_vec_simd.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <forward_list>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <thread>
 #include <vector>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #ifdef TEST
 #include <gtest/gtest.h>
@@ -295,6 +309,389 @@ TEST(VirtualVectorTest, TestResizeMore) {
     }
 }
 
+TEST(VirtualSoaTest, TestEmplaceBackAndIndex) {
+    virtual_soa<int, double, std::string> v;
+    for (int i = 0; i < 5; i++) {
+        v.emplace_back(i, i * 0.5, make_non_sso_string(std::to_string(i)));
+    }
+    ASSERT_EQ(5, v.size());
+    for (int i = 0; i < 5; i++) {
+        auto [id, half, name] = v[i];
+        EXPECT_EQ(i, id);
+        EXPECT_EQ(i * 0.5, half);
+        EXPECT_EQ(make_non_sso_string(std::to_string(i)), name);
+    }
+}
+
+TEST(VirtualSoaTest, TestRowProxyWritesThrough) {
+    virtual_soa<int, int> v;
+    v.emplace_back(1, 2);
+    std::get<1>(v[0]) = 42;
+    EXPECT_EQ(42, v.data<1>()[0]);
+    EXPECT_EQ(1, std::get<0>(v.front()));
+}
+
+TEST(VirtualSoaTest, TestColumnSpan) {
+    virtual_soa<int64_t, char> v;
+    int elems = (1 << 20) / sizeof(int64_t);
+    for (int64_t i = 0; i < elems; i++) {
+        v.emplace_back(i, 'x');
+    }
+    auto ids = v.column<0>();
+    ASSERT_EQ(v.size(), ids.size());
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(ids.data()) % 64);
+    EXPECT_EQ(int64_t(elems) * (elems - 1) / 2, std::accumulate(ids.begin(), ids.end(), int64_t(0)));
+    EXPECT_GE(v.capacity(), v.size());
+}
+
+TEST(VirtualSoaTest, TestAtThrows) {
+    virtual_soa<int, int> v;
+    EXPECT_THROW(v.at(0), std::out_of_range);
+}
+
+TEST(VirtualSoaTest, TestCopyMoveAndPop) {
+    virtual_soa<std::string, int> v0;
+    v0.emplace_back(make_non_sso_string("one"), 1);
+    v0.emplace_back(make_non_sso_string("two"), 2);
+    virtual_soa<std::string, int> v1(v0);
+    ASSERT_EQ(2, v1.size());
+    EXPECT_EQ(make_non_sso_string("two"), std::get<0>(v1[1]));
+
+    virtual_soa<std::string, int> v2(std::move(v1));
+    EXPECT_EQ(0, v1.size());
+    ASSERT_EQ(2, v2.size());
+    v2.pop_back();
+    ASSERT_EQ(1, v2.size());
+    EXPECT_EQ(make_non_sso_string("one"), std::get<0>(v2.back()));
+    EXPECT_EQ(1, std::get<1>(v2.back()));
+}
+
+TEST(VirtualVectorTest, TestAppendRange) {
+    virtual_vec<int> v{0, 1};
+    std::vector<int> more{2, 3, 4};
+    v.append_range(more);
+    ASSERT_EQ(5, v.size());
+    for (int i = 0; i < 5; i++) {
+        EXPECT_EQ(i, v[i]);
+    }
+
+    virtual_vec<std::string> strings;
+    std::vector<std::string> words{make_non_sso_string("a"), make_non_sso_string("b")};
+    strings.append_range(words);
+    ASSERT_EQ(2, strings.size());
+    EXPECT_EQ(make_non_sso_string("b"), strings[1]);
+}
+
+TEST(VirtualVectorTest, TestEraseIf) {
+    virtual_vec<std::string> myvec;
+    std::vector<std::string> stlvec;
+    for (int i = 0; i < 50; i++) {
+        myvec.emplace_back(make_non_sso_string(std::to_string(i)));
+        stlvec.emplace_back(make_non_sso_string(std::to_string(i)));
+    }
+    auto is_odd = [](const std::string& s) { return (s.back() - '0') % 2 == 1; };
+    auto removed = erase_if(myvec, is_odd);
+    auto expected = std::erase_if(stlvec, is_odd);
+    ASSERT_EQ(expected, removed);
+    ASSERT_EQ(stlvec.size(), myvec.size());
+    for (size_t i = 0; i < myvec.size(); i++) {
+        ASSERT_EQ(stlvec[i], myvec[i]);
+    }
+    EXPECT_EQ(0, myvec.erase_if(is_odd));
+}
+
+TEST(VirtualVectorTest, TestSwapRemove) {
+    virtual_vec<int> v{0, 1, 2, 3};
+    auto it = v.swap_remove(v.begin() + 1);
+    ASSERT_EQ(3, v.size());
+    EXPECT_EQ(3, *it);
+    EXPECT_EQ(0, v[0]);
+    EXPECT_EQ(2, v[2]);
+    v.swap_remove(std::prev(v.end()));
+    ASSERT_EQ(2, v.size());
+    EXPECT_EQ(3, v.back());
+}
+
+TEST(VirtualVectorTest, TestInsertBatch) {
+    virtual_vec<int> v{1, 3, 5};
+    std::vector<size_t> positions{0, 1, 2, 3};
+    std::vector<int> values{0, 2, 4, 6};
+    v.insert_batch(positions.begin(), positions.end(), values.begin());
+    ASSERT_EQ(7, v.size());
+    for (int i = 0; i < 7; i++) {
+        EXPECT_EQ(i, v[i]);
+    }
+}
+
+TEST(VirtualVectorTest, TestInsertBatchNontrivial) {
+    virtual_vec<std::string> myvec;
+    std::vector<std::string> stlvec;
+    for (int i = 0; i < 10; i++) {
+        myvec.emplace_back(make_non_sso_string(std::to_string(i)));
+        stlvec.emplace_back(make_non_sso_string(std::to_string(i)));
+    }
+    std::vector<size_t> positions{2, 2, 7, 10};
+    std::vector<std::string> values{make_non_sso_string("x"), make_non_sso_string("y"), make_non_sso_string("z"), make_non_sso_string("w")};
+    myvec.insert_batch(positions.begin(), positions.end(), values.begin());
+    for (size_t k = positions.size(); k-- > 0;) {
+        stlvec.insert(stlvec.begin() + positions[k], values[k]);
+    }
+    ASSERT_EQ(stlvec.size(), myvec.size());
+    for (size_t i = 0; i < myvec.size(); i++) {
+        ASSERT_EQ(stlvec[i], myvec[i]);
+    }
+}
+
+// Checks every kernel against the standard algorithms at every SIMD level the
+// CPU supports, on the whole vector and on a subrange that is not aligned.
+template <typename T>
+static void check_simd_kernels() {
+    virtual_vec<T> v;
+    for (int i = 0; i < 1000; i++) {
+        v.push_back(T((i * 7919) % 1013) - T(500));
+    }
+    v[517] = T(9999);
+    for (auto level : {simd_level::scalar, simd_level::avx2, simd_level::avx512}) {
+        if (level > simd_detected_level()) { continue; }
+        simd_set_level(level);
+        for (size_t offset : {size_t(0), size_t(3)}) {
+            const T* first = v.cbegin() + offset;
+            const T* last = v.cend() - offset;
+            EXPECT_EQ(std::find(first, last, T(9999)), simd_find(first, last, T(9999)));
+            EXPECT_EQ(last, simd_find(first, last, T(12345)));
+            EXPECT_EQ(std::count(first, last, T(13)), simd_count(first, last, T(13)));
+            EXPECT_EQ(*std::min_element(first, last), simd_min(first, last));
+            EXPECT_EQ(*std::max_element(first, last), simd_max(first, last));
+            EXPECT_EQ(std::accumulate(first, last, typename std::conditional<std::is_floating_point<T>::value, double, int64_t>::type(0)),
+                      simd_sum(first, last));
+
+            virtual_vec<uint32_t> indices;
+            simd_filter_greater(first, last, T(400), indices);
+            std::vector<uint32_t> expected;
+            for (const T* it = first; it != last; it++) {
+                if (*it > T(400)) expected.push_back(uint32_t(it - first));
+            }
+            ASSERT_EQ(expected.size(), indices.size());
+            EXPECT_TRUE(std::equal(expected.begin(), expected.end(), indices.begin()));
+        }
+    }
+    simd_set_level(simd_detected_level());
+}
+
+TEST(VirtualVectorSimdTest, TestKernelsInt32) { check_simd_kernels<int32_t>(); }
+TEST(VirtualVectorSimdTest, TestKernelsInt64) { check_simd_kernels<int64_t>(); }
+TEST(VirtualVectorSimdTest, TestKernelsFloat) { check_simd_kernels<float>(); }
+
+TEST(VirtualVectorSimdTest, TestThreadedReductions) {
+    virtual_vec<int32_t> v;
+    for (int32_t i = 0; i < int32_t(3 * simd_parallel_threshold()); i++) {
+        v.push_back(i % 977);
+    }
+    EXPECT_EQ(simd_sum(v), simd_sum(v, 4));
+    EXPECT_EQ(simd_count(v, 5), simd_count(v, 5, 3));
+    EXPECT_EQ(0, simd_min(v, 4));
+    EXPECT_EQ(976, simd_max(v, 4));
+}
+
+TEST(VirtualVectorTest, TestAdviceSurvivesGrowAndMove) {
+    virtual_vec<int64_t> v;
+    v.advise(memory_advice::dont_dump | memory_advice::wipe_on_fork);
+    for (int64_t i = 0; i < (1 << 16); i++) {
+        v.push_back(i + 1);
+    }
+    v.shrink_to_fit();
+    virtual_vec<int64_t> moved(std::move(v));
+    EXPECT_EQ(memory_advice::dont_dump | memory_advice::wipe_on_fork, moved.advice());
+    EXPECT_EQ(memory_advice::none, v.advice());
+
+    // Pages committed after advise() must be wiped in the child as well.
+    pid_t pid = fork();
+    ASSERT_NE(-1, pid);
+    if (pid == 0) {
+        _exit(moved[0] == 0 && moved[moved.size() - 1] == 0 ? 0 : 1);
+    }
+    int status = 0;
+    ASSERT_EQ(pid, waitpid(pid, &status, 0));
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(0, WEXITSTATUS(status));
+    EXPECT_EQ(1, moved[0]);
+    EXPECT_EQ(1 << 16, moved.back());
+
+    moved.advise(memory_advice::none);
+    EXPECT_EQ(memory_advice::none, moved.advice());
+}
+
+TEST(VirtualSoaTest, TestMoveAssign) {
+    virtual_soa<std::string, int> v0, v1;
+    v0.emplace_back(make_non_sso_string("zero"), 0);
+    v1.emplace_back(make_non_sso_string("one"), 1);
+    v1 = std::move(v0);
+    ASSERT_EQ(1, v1.size());
+    EXPECT_EQ(make_non_sso_string("zero"), std::get<0>(v1[0]));
+    EXPECT_EQ(0, v0.size());
+
+    auto& self = v1;
+    v1 = std::move(self);
+    ASSERT_EQ(1, v1.size());
+    EXPECT_EQ(0, std::get<1>(v1[0]));
+}
+
+TEST(VirtualVectorTest, TestSelfMoveAssign) {
+    virtual_vec<int> v{1, 2, 3};
+    auto& self = v;
+    v = std::move(self);
+    ASSERT_EQ(3, v.size());
+    EXPECT_EQ(3, v.back());
+}
+
+TEST(VirtualVectorTest, TestInsertBatchThrows) {
+    virtual_vec<int> v{0, 1, 2};
+    std::vector<int> values{7, 8};
+    std::vector<size_t> past_end{1, 4};
+    EXPECT_THROW(v.insert_batch(past_end.begin(), past_end.end(), values.begin()), std::out_of_range);
+    std::vector<size_t> unsorted{2, 1};
+    EXPECT_THROW(v.insert_batch(unsorted.begin(), unsorted.end(), values.begin()), std::out_of_range);
+    ASSERT_EQ(3, v.size());
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(i, v[i]);
+    }
+}
+
+// Reference min/max that skips NaN, which is what simd_min/simd_max promise.
+template <bool IsMin>
+static float reference_minmax(const float* first, const float* last) {
+    float result = std::numeric_limits<float>::quiet_NaN();
+    for (; first != last; first++) {
+        if (std::isnan(*first)) { continue; }
+        if (std::isnan(result) || (IsMin ? *first < result : *first > result)) result = *first;
+    }
+    return result;
+}
+
+TEST(VirtualVectorSimdTest, TestMinMaxNaN) {
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    virtual_vec<float> v;
+    for (int i = 0; i < 64; i++) {
+        v.push_back(float(i % 7));
+    }
+    v[16] = -100;
+    v[20] = 100;
+    v[48] = nan;
+    virtual_vec<float> first_nan = v;
+    first_nan[0] = nan;
+    virtual_vec<float> all_nan(64, nan);
+    for (auto level : {simd_level::scalar, simd_level::avx2, simd_level::avx512}) {
+        if (level > simd_detected_level()) { continue; }
+        simd_set_level(level);
+        for (const virtual_vec<float>* input : {&v, &first_nan}) {
+            for (size_t offset : {size_t(0), size_t(3)}) {
+                const float* first = input->cbegin() + offset;
+                const float* last = input->cend() - offset;
+                EXPECT_EQ(reference_minmax<true>(first, last), simd_min(first, last));
+                EXPECT_EQ(reference_minmax<false>(first, last), simd_max(first, last));
+            }
+        }
+        EXPECT_TRUE(std::isnan(simd_min(all_nan)));
+        EXPECT_TRUE(std::isnan(simd_max(all_nan)));
+    }
+    simd_set_level(simd_detected_level());
+}
+
+TEST(VirtualVectorSimdTest, TestThreadsClamped) {
+    virtual_vec<int32_t> v{3, 1, 2};
+    EXPECT_EQ(1, simd_min(v, 64));
+    EXPECT_EQ(3, simd_max(v, 64));
+    EXPECT_EQ(6, simd_sum(v, 64));
+}
+
+// Throws from its constructor when asked to, for exception safety tests.
+struct ThrowOnConstruct {
+    explicit ThrowOnConstruct(bool should_throw) {
+        if (should_throw) throw std::runtime_error("ThrowOnConstruct");
+    }
+};
+
+TEST(VirtualSoaTest, TestEmplaceBackThrowDestroysBuiltFields) {
+    static int live = 0;
+    struct Counted {
+        Counted() { live++; }
+        Counted(const Counted&) { live++; }
+        ~Counted() { live--; }
+    };
+    {
+        virtual_soa<Counted, std::string, ThrowOnConstruct> v;
+        v.emplace_back(Counted(), make_non_sso_string("kept"), false);
+        EXPECT_THROW(v.emplace_back(Counted(), make_non_sso_string("leaked"), true), std::runtime_error);
+        ASSERT_EQ(1, v.size());
+        EXPECT_EQ(1, live);
+        EXPECT_EQ(make_non_sso_string("kept"), std::get<1>(v[0]));
+    }
+    EXPECT_EQ(0, live);
+}
+
+TEST(VirtualVectorTest, TestInsertBatchSignedPositionsForwardValues) {
+    virtual_vec<int> v{1, 3};
+    std::vector<int> positions{0, 1, 2};
+    std::forward_list<int> values{0, 2, 4};
+    v.insert_batch(positions.begin(), positions.end(), values.begin());
+    ASSERT_EQ(5, v.size());
+    for (int i = 0; i < 5; i++) {
+        EXPECT_EQ(i, v[i]);
+    }
+    std::vector<int> negative{-1};
+    EXPECT_THROW(v.insert_batch(negative.begin(), negative.end(), values.begin()), std::out_of_range);
+}
+
+TEST(VirtualVectorSimdTest, TestConvenienceOverloadsConvertValue) {
+    virtual_vec<int64_t> ints{3, -1, 5};
+    virtual_vec<float> floats{1.0f, 2.0f, 1.0f};
+    EXPECT_EQ(ints.cbegin() + 1, simd_find(ints, -1));
+    EXPECT_EQ(2, simd_count(floats, 1.0));
+    virtual_vec<uint32_t> out;
+    simd_filter_greater(ints, 0, out);
+    ASSERT_EQ(2, out.size());
+    EXPECT_EQ(0, out[0]);
+    EXPECT_EQ(2, out[1]);
+}
+
+TEST(VirtualVectorSimdTest, TestFilterGreaterRejectsHugeRange) {
+    // The range is never dereferenced: the length check comes first.
+    const float* first = reinterpret_cast<const float*>(uintptr_t(1) << 40);
+    const float* last = first + (size_t(UINT32_MAX) + 1);
+    virtual_vec<uint32_t> out;
+    EXPECT_THROW(simd_filter_greater(first, last, 0.0f, out), std::out_of_range);
+}
+
+// Returns the VmFlags line of /proc/self/smaps for the mapping starting at p.
+static std::string vm_flags_of(const void* p) {
+    std::ifstream smaps("/proc/self/smaps");
+    char start[32];
+    snprintf(start, sizeof(start), "%lx-", reinterpret_cast<unsigned long>(p));
+    bool found = false;
+    for (std::string line; std::getline(smaps, line);) {
+        if (line.rfind(start, 0) == 0) found = true;
+        if (found && line.rfind("VmFlags:", 0) == 0) return line;
+    }
+    return "";
+}
+
+TEST(VirtualVectorTest, TestFailedAdviseKeepsPreviousAdvice) {
+    virtual_vec<int> v;
+    v.push_back(1);
+    v.advise(memory_advice::wipe_on_fork);
+    ASSERT_NE(std::string::npos, vm_flags_of(v.data()).find(" wf"));
+
+    // Punch a hole at the end of the reservation so madvise over the whole
+    // range fails with ENOMEM after advising the part that is still mapped.
+    const size_t page = sysconf(_SC_PAGESIZE);
+    ASSERT_EQ(0, munmap(reinterpret_cast<uint8_t*>(v.data()) + Memory::avail_mem() - page, page));
+    EXPECT_THROW(v.advise(memory_advice::wipe_on_fork | memory_advice::dont_dump), std::runtime_error);
+    EXPECT_EQ(memory_advice::wipe_on_fork, v.advice());
+    std::string flags = vm_flags_of(v.data());
+    EXPECT_NE(std::string::npos, flags.find(" wf"));
+    EXPECT_EQ(std::string::npos, flags.find(" dd"));
+}
+
 #endif  // #ifdef TEST
 
 #ifdef BENCH
@@ -313,4 +710,174 @@ static void BV_vector(benchmark::State& state) {
 BENCHMARK_TEMPLATE1(BV_vector, std::vector)->RangeMultiplier(2)->Range(10, 10 << 20);
 BENCHMARK_TEMPLATE1(BV_vector, virtual_vec)->RangeMultiplier(2)->Range(10, 10 << 20);
 
+// A wide record where a scan only needs one field.
+struct Record {
+    int64_t id;
+    double price;
+    int32_t quantity;
+    std::array<char, 44> payload;
+};
+
+static void BV_scan_aos(benchmark::State& state) {
+    virtual_vec<Record> v;
+    int64_t count = state.range(0) / sizeof(Record);
+    for (int64_t i = 0; i < count; i++) {
+        v.push_back(Record{i, double(i), int32_t(i), {}});
+    }
+    for (auto _ : state) {
+        double sum = 0;
+        for (const auto& r : v) {
+            sum += r.price;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+}
+
+static void BV_scan_soa(benchmark::State& state) {
+    virtual_soa<int64_t, double, int32_t, std::array<char, 44>> v;
+    int64_t count = state.range(0) / sizeof(Record);
+    for (int64_t i = 0; i < count; i++) {
+        v.emplace_back(i, double(i), int32_t(i), std::array<char, 44>{});
+    }
+    for (auto _ : state) {
+        double sum = 0;
+        for (double price : v.column<1>()) {
+            sum += price;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+}
+
+BENCHMARK(BV_scan_aos)->RangeMultiplier(4)->Range(4 << 10, 64 << 20);
+BENCHMARK(BV_scan_soa)->RangeMultiplier(4)->Range(4 << 10, 64 << 20);
+
+static void BV_erase_loop(benchmark::State& state) {
+    for (auto _ : state) {
+        state.PauseTiming();
+        virtual_vec<int64_t> v;
+        for (int64_t i = 0; i < state.range(0); i++) v.push_back(i);
+        state.ResumeTiming();
+        for (auto it = v.begin(); it != v.end();) {
+            it = (*it % 2 == 0) ? v.erase(it) : std::next(it);
+        }
+        benchmark::DoNotOptimize(v.data());
+    }
+}
+
+static void BV_erase_if(benchmark::State& state) {
+    for (auto _ : state) {
+        state.PauseTiming();
+        virtual_vec<int64_t> v;
+        for (int64_t i = 0; i < state.range(0); i++) v.push_back(i);
+        state.ResumeTiming();
+        v.erase_if([](int64_t x) { return x % 2 == 0; });
+        benchmark::DoNotOptimize(v.data());
+    }
+}
+
+static void BV_insert_loop(benchmark::State& state) {
+    std::vector<size_t> positions;
+    for (int64_t i = 0; i < state.range(0); i += 16) positions.push_back(i);
+    for (auto _ : state) {
+        state.PauseTiming();
+        virtual_vec<int64_t> v;
+        for (int64_t i = 0; i < state.range(0); i++) v.push_back(i);
+        state.ResumeTiming();
+        for (size_t k = positions.size(); k-- > 0;) {
+            v.emplace(v.begin() + positions[k], -1);
+        }
+        benchmark::DoNotOptimize(v.data());
+    }
+}
+
+static void BV_insert_batch(benchmark::State& state) {
+    std::vector<size_t> positions;
+    for (int64_t i = 0; i < state.range(0); i += 16) positions.push_back(i);
+    std::vector<int64_t> values(positions.size(), -1);
+    for (auto _ : state) {
+        state.PauseTiming();
+        virtual_vec<int64_t> v;
+        for (int64_t i = 0; i < state.range(0); i++) v.push_back(i);
+        state.ResumeTiming();
+        v.insert_batch(positions.begin(), positions.end(), values.begin());
+        benchmark::DoNotOptimize(v.data());
+    }
+}
+
+BENCHMARK(BV_erase_loop)->RangeMultiplier(4)->Range(1 << 8, 1 << 16);
+BENCHMARK(BV_erase_if)->RangeMultiplier(4)->Range(1 << 8, 1 << 16);
+BENCHMARK(BV_insert_loop)->RangeMultiplier(4)->Range(1 << 8, 1 << 16);
+BENCHMARK(BV_insert_batch)->RangeMultiplier(4)->Range(1 << 8, 1 << 16);
+
+template <typename T>
+static void fill_scan_column(virtual_vec<T>& v, int64_t bytes) {
+    int64_t count = bytes / sizeof(T);
+    v.reserve(count);
+    for (int64_t i = 0; i < count; i++) {
+        v.push_back(T(i % 1000));
+    }
+}
+
+static void BV_std_find(benchmark::State& state) {
+    virtual_vec<int32_t> v;
+    fill_scan_column(v, state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(std::find(v.cbegin(), v.cend(), -1));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+static void BV_simd_find(benchmark::State& state) {
+    virtual_vec<int32_t> v;
+    fill_scan_column(v, state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(simd_find(v, -1));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+static void BV_std_accumulate(benchmark::State& state) {
+    virtual_vec<int32_t> v;
+    fill_scan_column(v, state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(std::accumulate(v.cbegin(), v.cend(), int64_t(0)));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+static void BV_simd_sum(benchmark::State& state) {
+    virtual_vec<int32_t> v;
+    fill_scan_column(v, state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(simd_sum(v, std::thread::hardware_concurrency()));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BV_std_find)->RangeMultiplier(16)->Range(1LL << 20, 4LL << 30);
+BENCHMARK(BV_simd_find)->RangeMultiplier(16)->Range(1LL << 20, 4LL << 30);
+BENCHMARK(BV_std_accumulate)->RangeMultiplier(16)->Range(1LL << 20, 4LL << 30);
+BENCHMARK(BV_simd_sum)->RangeMultiplier(16)->Range(1LL << 20, 4LL << 30);
+
+// Forks a process that holds state.range(0) GB of committed vectors, with or
+// without advice keeping those pages out of the child.
+template <memory_advice Advice>
+static void BV_fork(benchmark::State& state) {
+    constexpr size_t vector_bytes = 512ULL << 20;
+    std::vector<virtual_vec<int64_t>> vectors(state.range(0) * 2);
+    for (auto& v : vectors) {
+        v.advise(Advice);
+        v.resize(vector_bytes / sizeof(int64_t), 1);
+    }
+    for (auto _ : state) {
+        pid_t pid = fork();
+        if (pid == 0) { _exit(0); }
+        waitpid(pid, nullptr, 0);
+    }
+}
+
+BENCHMARK_TEMPLATE1(BV_fork, memory_advice::none)->Arg(1)->Arg(2)->Arg(4)->Unit(benchmark::kMicrosecond)->UseRealTime();
+BENCHMARK_TEMPLATE1(BV_fork, memory_advice::dont_fork)->Arg(1)->Arg(2)->Arg(4)->Unit(benchmark::kMicrosecond)->UseRealTime();
+BENCHMARK_TEMPLATE1(BV_fork, memory_advice::wipe_on_fork)->Arg(1)->Arg(2)->Arg(4)->Unit(benchmark::kMicrosecond)->UseRealTime();
+
 #endif  // #ifdef BENCH
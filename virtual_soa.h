@@ -0,0 +1,191 @@
+#pragma once
+
+#include "virtual_vec.h"
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Structure-of-arrays counterpart to virtual_vec. Every field gets its own
+// column backed by its own Memory reservation, so a scan over one field only
+// touches the pages of that field. All columns share a single size.
+template <typename... Ts>
+class virtual_soa {
+    static_assert(sizeof...(Ts) > 0, "virtual_soa needs at least one column");
+
+ public:
+    static constexpr size_t num_columns = sizeof...(Ts);
+
+    template <size_t I>
+    using column_type = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+    using size_type = size_t;
+    using value_type = std::tuple<Ts...>;
+    using reference = std::tuple<Ts&...>;
+    using const_reference = std::tuple<const Ts&...>;
+
+ public:
+    virtual_soa() = default;
+    ~virtual_soa() { clear(); }
+
+    virtual_soa(const virtual_soa& other) {
+        reserve(other.size());
+        for (size_type i = 0; i < other.size(); i++) {
+            std::apply([this](const Ts&... fields) { emplace_back(fields...); }, other[i]);
+        }
+    }
+
+    virtual_soa& operator=(const virtual_soa& other) {
+        if (this == &other) { return *this; }
+        clear();
+        reserve(other.size());
+        for (size_type i = 0; i < other.size(); i++) {
+            std::apply([this](const Ts&... fields) { emplace_back(fields...); }, other[i]);
+        }
+        return *this;
+    }
+
+    virtual_soa(virtual_soa&& other) noexcept
+        : memory_(std::move(other.memory_)),
+          count_(other.count_) {
+        other.count_ = 0;
+    }
+
+    virtual_soa& operator=(virtual_soa&& other) {
+        if (this == &other) { return *this; }
+        clear();
+        memory_ = std::move(other.memory_);
+        count_ = other.count_;
+        other.count_ = 0;
+        return *this;
+    }
+
+    inline reference       operator[](size_type pos)       { return row(pos, index_sequence()); }
+    inline const_reference operator[](size_type pos) const { return row(pos, index_sequence()); }
+    inline reference front()                               { return (*this)[0]; }
+    inline const_reference front()                   const { return (*this)[0]; }
+    inline reference back()                                { return (*this)[size() - 1]; }
+    inline const_reference back()                    const { return (*this)[size() - 1]; }
+
+    reference at(size_type pos) {
+        if (!(pos < size())) {
+            throw std::out_of_range("Out of bounds");
+        }
+        return this->operator[](pos);
+    }
+
+    const_reference at(size_type pos) const {
+        if (!(pos < size())) {
+            throw std::out_of_range("Out of bounds");
+        }
+        return this->operator[](pos);
+    }
+
+    // Columns start on a page boundary, so data<I>() is suitably aligned for
+    // any vector load.
+    template <size_t I> inline column_type<I>* data()                  noexcept { return column_ptr<I>(); }
+    template <size_t I> inline const column_type<I>* data()      const noexcept { return column_ptr<I>(); }
+    template <size_t I> inline std::span<column_type<I>> column()       noexcept { return {column_ptr<I>(), size()}; }
+    template <size_t I> inline std::span<const column_type<I>> column() const noexcept { return {column_ptr<I>(), size()}; }
+
+    [[nodiscard]] inline bool empty()       const noexcept { return size() == 0; }
+    inline size_type size()                 const noexcept { return count_; }
+    inline size_type max_size()             const noexcept { return Memory::avail_mem() / std::max({sizeof(Ts)...}); }
+    inline size_type capacity()             const noexcept { return capacity_of(index_sequence()); }
+    inline void reserve(size_type new_cap)                 { reserve_columns(new_cap, index_sequence()); }
+    inline void shrink_to_fit()                            { shrink_columns(index_sequence()); }
+    inline void advise(memory_advice advice)               { for (auto& column : memory_) column.advise(advice); }
+    inline memory_advice advice()           const noexcept { return memory_[0].advice(); }
+
+    inline void clear()                           noexcept { deinit_from(0, index_sequence()); count_ = 0; }
+    inline void pop_back()                                 { deinit_from(size() - 1, index_sequence()); count_ -= 1; }
+    inline void swap(virtual_soa& other)          noexcept { std::swap(count_, other.count_); std::swap(memory_, other.memory_); }
+
+    // Takes exactly one argument per column; argument I constructs field I.
+    template <class... Args>
+    reference emplace_back(Args&&... fields) {
+        static_assert(sizeof...(Args) == num_columns, "emplace_back takes one argument per column");
+        reserve(size() + 1);
+        construct_row(count_, index_sequence(), std::forward<Args>(fields)...);
+        count_ += 1;
+        return back();
+    }
+
+    inline void push_back(const value_type& value) {
+        std::apply([this](const Ts&... fields) { emplace_back(fields...); }, value);
+    }
+
+ private:
+    using index_sequence = std::index_sequence_for<Ts...>;
+
+    template <size_t I>
+    inline column_type<I>* column_ptr() const noexcept {
+        return reinterpret_cast<column_type<I>*>(memory_[I].pointer());
+    }
+
+    template <size_t... Is>
+    inline reference row(size_type pos, std::index_sequence<Is...>) {
+        return reference(column_ptr<Is>()[pos]...);
+    }
+
+    template <size_t... Is>
+    inline const_reference row(size_type pos, std::index_sequence<Is...>) const {
+        return const_reference(column_ptr<Is>()[pos]...);
+    }
+
+    // If a field constructor throws, the fields already built for this row are
+    // destroyed, in reverse order, before the exception propagates.
+    template <size_t... Is, class... Args>
+    inline void construct_row(size_type pos, std::index_sequence<Is...>, Args&&... fields) {
+        size_type constructed = 0;
+        try {
+            ((new (&column_ptr<Is>()[pos]) column_type<Is>(std::forward<Args>(fields)), constructed++), ...);
+        } catch (...) {
+            (destroy_field<num_columns - 1 - Is>(pos, constructed), ...);
+            throw;
+        }
+    }
+
+    template <size_t I>
+    inline void destroy_field(size_type pos, size_type constructed) noexcept {
+        if constexpr (!std::is_trivial<column_type<I>>::value) {
+            if (I < constructed) column_ptr<I>()[pos].~column_type<I>();
+        }
+    }
+
+    template <size_t... Is>
+    inline size_type capacity_of(std::index_sequence<Is...>) const noexcept {
+        return std::min({ (memory_[Is].num_bytes() / sizeof(column_type<Is>))... });
+    }
+
+    template <size_t... Is>
+    inline void reserve_columns(size_type new_cap, std::index_sequence<Is...>) {
+        ((memory_[Is].num_bytes() < new_cap * sizeof(column_type<Is>)
+            ? memory_[Is].grow(new_cap * sizeof(column_type<Is>)) : void()), ...);
+    }
+
+    template <size_t... Is>
+    inline void shrink_columns(std::index_sequence<Is...>) {
+        (memory_[Is].shrink(size() * sizeof(column_type<Is>)), ...);
+    }
+
+    template <size_t I>
+    inline void deinit_column_from(size_type offset) noexcept {
+        if constexpr (!std::is_trivial<column_type<I>>::value) {
+            column_type<I>* ptr = column_ptr<I>();
+            for (size_type i = offset; i < size(); i++) ptr[i].~column_type<I>();
+        }
+    }
+
+    template <size_t... Is>
+    inline void deinit_from(size_type offset, std::index_sequence<Is...>) noexcept {
+        (deinit_column_from<Is>(offset), ...);
+    }
+
+    std::array<Memory, num_columns> memory_;
+    std::size_t count_ = 0;
+};
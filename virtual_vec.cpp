@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <stdexcept>
 #include <sys/mman.h>
 
@@ -55,8 +56,14 @@ namespace {
 };
 
 Memory::~Memory() {
+    release();
+}
+
+void Memory::release() {
     if (memory_) {
-        munmap(memory_, num_bytes());
+        munmap(memory_, Memory::avail_mem());
+        memory_ = nullptr;
+        num_bytes_ = 0;
     }
 }
 
@@ -68,6 +75,47 @@ void Memory::reserve() {
     }
     memory_ = static_cast<uint8_t*>(memory);
     num_bytes_ = 0;
+    // A fresh mapping starts out with none of the advice applied. If the
+    // advice cannot be applied, drop the mapping so the next grow() retries
+    // instead of committing pages without it.
+    try {
+        apply_advice(memory_advice::none, advice_);
+    } catch (...) {
+        release();
+        throw;
+    }
+}
+
+void Memory::advise(memory_advice advice) {
+    if (memory_ != nullptr) { apply_advice(advice_, advice); }
+    advice_ = advice;
+}
+
+// Moves the reservation from advice from to advice to. On failure, every flag
+// touched so far (including the failing one, which may have been applied to
+// part of the range) is reverted, so the mapping is left with advice from.
+void Memory::apply_advice(memory_advice from, memory_advice to) {
+    struct Flag { memory_advice advice; int set; int clear; };
+    constexpr Flag flags[] = {
+        { memory_advice::dont_fork,    MADV_DONTFORK,   MADV_DOFORK },
+        { memory_advice::wipe_on_fork, MADV_WIPEONFORK, MADV_KEEPONFORK },
+        { memory_advice::dont_dump,    MADV_DONTDUMP,   MADV_DODUMP },
+        { memory_advice::mergeable,    MADV_MERGEABLE,  MADV_UNMERGEABLE },
+    };
+    for (size_t i = 0; i < std::size(flags); i++) {
+        bool wanted = (to & flags[i].advice) != memory_advice::none;
+        bool current = (from & flags[i].advice) != memory_advice::none;
+        if (wanted == current) { continue; }
+        int r = madvise(memory_, Memory::avail_mem(), wanted ? flags[i].set : flags[i].clear);
+        if (r != 0) {
+            for (size_t j = 0; j <= i; j++) {
+                bool was = (from & flags[j].advice) != memory_advice::none;
+                if (was == ((to & flags[j].advice) != memory_advice::none)) { continue; }
+                madvise(memory_, Memory::avail_mem(), was ? flags[j].set : flags[j].clear);
+            }
+            throw std::runtime_error("Could not madvise");
+        }
+    }
 }
 
 void Memory::grow(size_t wanted) {
@@ -3,8 +3,10 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <initializer_list>
 #include <iterator>
+#include <ranges>
 #include <stdexcept>
 #include <type_traits>
 #include <utility>
@@ -59,6 +61,28 @@ static inline OutputIterator fill_n(OutputIterator first, Size count, const T& v
 
 }  // namespace
 
+// Kernel advice applied to a whole reservation. Flags can be combined with |.
+enum class memory_advice : unsigned {
+    none         = 0,
+    // Committed pages are not mapped into children after fork(). The child
+    // must not touch the vector.
+    dont_fork    = 1 << 0,
+    // Children see the pages zero-filled instead of sharing them copy-on-write.
+    wipe_on_fork = 1 << 1,
+    // Pages are left out of core dumps.
+    dont_dump    = 1 << 2,
+    // Pages may be merged with identical pages by KSM.
+    mergeable    = 1 << 3,
+};
+
+constexpr inline memory_advice operator|(memory_advice a, memory_advice b) {
+    return static_cast<memory_advice>(static_cast<unsigned>(a) | static_cast<unsigned>(b));
+}
+
+constexpr inline memory_advice operator&(memory_advice a, memory_advice b) {
+    return static_cast<memory_advice>(static_cast<unsigned>(a) & static_cast<unsigned>(b));
+}
+
 class Memory {
 public:
     Memory() = default;
@@ -73,16 +97,22 @@ public:
 
     Memory(Memory&& other) noexcept
           : memory_(other.memory_),
-            num_bytes_(other.num_bytes_) {
+            num_bytes_(other.num_bytes_),
+            advice_(other.advice_) {
         other.memory_ = nullptr;
         other.num_bytes_ = 0;
+        other.advice_ = memory_advice::none;
     }
 
     Memory& operator=(Memory&& other) {
+        if (this == &other) { return *this; }
+        release();
         memory_ = other.memory_;
         num_bytes_ = other.num_bytes_;
+        advice_ = other.advice_;
         other.memory_ = nullptr;
         other.num_bytes_ = 0;
+        other.advice_ = memory_advice::none;
         return *this;
     }
 
@@ -93,11 +123,21 @@ public:
     inline size_t num_bytes() const { return num_bytes_ ; }
     inline uint8_t* pointer() const { return memory_; };
 
+    // Replaces the advice on the reservation. The advice covers the whole
+    // reservation, so it carries over to pages committed later by grow(). If
+    // the kernel rejects any flag, the previous advice is restored and
+    // std::runtime_error is thrown.
+    void advise(memory_advice advice);
+    inline memory_advice advice() const { return advice_; }
+
 private:
     void reserve();
+    void release();
+    void apply_advice(memory_advice from, memory_advice to);
 
     uint8_t* memory_ = nullptr;
     size_t num_bytes_ = 0;
+    memory_advice advice_ = memory_advice::none;
 };
 
 template <typename T>
@@ -139,7 +179,8 @@ class virtual_vec {
     }
 
     virtual_vec& operator=(virtual_vec&& other) {
-        reserve(other.capacity());
+        if (this == &other) { return *this; }
+        clear();
         memory_ = std::move(other.memory_);
         count_ = other.count_;
         other.count_ = 0;
@@ -167,6 +208,8 @@ class virtual_vec {
     inline size_type max_size()             const noexcept { return Memory::avail_mem() / sizeof(T); }
     inline size_type capacity()             const noexcept { return capacity_in_bytes() / sizeof(T); }
     inline void reserve(size_type new_cap)                 { reserve_in_bytes(new_cap * sizeof(T)); }
+    inline void advise(memory_advice advice)               { memory_.advise(advice); }
+    inline memory_advice advice()           const noexcept { return memory_.advice(); }
     void shrink_to_fit() {
         auto new_size = size() * sizeof(T);
         deinit_until(new_size);
@@ -271,6 +314,96 @@ class virtual_vec {
         return _pos;
     }
 
+    // Appends every element of range, committing capacity once when the size
+    // of the range is known up front.
+    template<class Range>
+    void append_range(Range&& range) {
+        if constexpr (std::ranges::sized_range<Range>) {
+            size_type n = std::ranges::size(range);
+            reserve(size() + n);
+            if constexpr (std::is_trivially_copyable<T>::value && std::ranges::contiguous_range<Range>
+                          && std::is_same<std::ranges::range_value_t<Range>, T>::value) {
+                if (n != 0) std::memcpy(end(), std::ranges::data(range), n * sizeof(T));
+                count_ += n;
+                return;
+            }
+        }
+        for (auto&& value : range) {
+            emplace_back(std::forward<decltype(value)>(value));
+        }
+    }
+
+    // Removes every element matching pred in a single pass. Survivors keep
+    // their relative order and each is moved at most once.
+    template<class Predicate>
+    size_type erase_if(Predicate pred) {
+        iterator write = std::find_if(begin(), end(), pred);
+        if (write == end()) { return 0; }
+        for (iterator read = std::next(write); read != end(); read++) {
+            if (!pred(*read)) {
+                *write++ = std::move(*read);
+            }
+        }
+        size_type removed = std::distance(write, end());
+        deinit_from(write);
+        count_ -= removed;
+        return removed;
+    }
+
+    // Unstable O(1) erase: the last element is moved into pos.
+    iterator swap_remove(const_iterator pos) {
+        iterator _pos = &this->operator[](std::distance(cbegin(), pos));
+        iterator last = std::prev(end());
+        if (_pos != last) {
+            *_pos = std::move(*last);
+        }
+        deinit_range(last, end());
+        count_ -= 1;
+        return _pos;
+    }
+
+    // Inserts *values_first, *std::next(values_first), ... before the original
+    // indices in [pos_first, pos_last), which must be sorted ascending. The
+    // tail is shifted once, from the back, so each existing element moves at
+    // most once regardless of how many positions are given; the values are
+    // then written front to back, so ValueIterator only needs to be a forward
+    // iterator. PositionIterator must be bidirectional. Throws
+    // std::out_of_range, before touching any element, if the positions are
+    // unsorted or past size().
+    template<class PositionIterator, class ValueIterator>
+    void insert_batch(PositionIterator pos_first, PositionIterator pos_last, ValueIterator values_first) {
+        size_type n = std::distance(pos_first, pos_last);
+        if (n == 0) { return; }
+        size_type old_size = size();
+        size_type previous = 0;
+        for (PositionIterator pos = pos_first; pos != pos_last; pos++) {
+            // Negative positions wrap around and fail the size check.
+            size_type at = static_cast<size_type>(*pos);
+            if (at < previous || at > old_size) {
+                throw std::out_of_range("Out of bounds");
+            }
+            previous = at;
+        }
+        reserve(old_size + n);
+        T* base = memory_ptr();
+        size_type src_end = old_size;
+        size_type dst_end = old_size + n;
+        for (PositionIterator pos = pos_last; pos != pos_first;) {
+            size_type at = static_cast<size_type>(*--pos);
+            size_type run = src_end - at;
+            dst_end -= run;
+            shift_run(base, at, dst_end, run, old_size);
+            // Leave a gap for the value; it is filled below.
+            dst_end -= 1;
+            src_end = at;
+        }
+        size_type k = 0;
+        for (PositionIterator pos = pos_first; pos != pos_last; pos++, values_first++, k++) {
+            place(base, static_cast<size_type>(*pos) + k, *values_first, old_size);
+        }
+        count_ = old_size + n;
+    }
+
  private:
   constexpr inline bool needs_deinit()                            { return !std::is_trivial<T>::value; }
   inline T* memory_ptr()                           const noexcept { return reinterpret_cast<T*>(memory_.pointer()); }
@@ -288,6 +421,29 @@ class virtual_vec {
       Uninitialized<T>::fill_n(begin(), size(), value);
   }
 
+  // Writes value to slot i, constructing it if it lies past the initialized
+  // prefix [0, live) and assigning to it otherwise.
+  template<typename U>
+  static inline void place(T* base, size_type i, U&& value, size_type live) {
+      if (i < live) {
+          base[i] = std::forward<U>(value);
+      } else {
+          new (&base[i]) T(std::forward<U>(value));
+      }
+  }
+
+  // Moves base[src, src + n) to base[dst, dst + n) with dst >= src.
+  static inline void shift_run(T* base, size_type src, size_type dst, size_type n, size_type live) {
+      if (n == 0 || src == dst) { return; }
+      if constexpr (std::is_trivially_copyable<T>::value) {
+          std::memmove(&base[dst], &base[src], n * sizeof(T));
+      } else {
+          for (size_type i = n; i-- > 0;) {
+              place(base, dst + i, std::move(base[src + i]), live);
+          }
+      }
+  }
+
   template<typename Iterator>
   iterator move_right_by(Iterator pos, size_type n) {
       reserve(size() + n);
@@ -318,3 +474,8 @@ class virtual_vec {
   Memory memory_;
   std::size_t count_ = 0;
 };
+
+template <typename T, class Predicate>
+inline typename virtual_vec<T>::size_type erase_if(virtual_vec<T>& v, Predicate pred) {
+    return v.erase_if(pred);
+}
@@ -0,0 +1,336 @@
+#include "virtual_vec_simd.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    // Sums are accumulated in a type wide enough not to overflow.
+    template <typename T> struct SumOf          { using type = int64_t; };
+    template <>           struct SumOf<float>   { using type = double; };
+
+    // Scalar fallback. Lanes of one make every kernel degenerate into its
+    // plain loop.
+    template <typename T>
+    struct ScalarOps {
+        static constexpr size_t lanes = 1;
+        static constexpr size_t bytes = sizeof(T);
+        using vec = T;
+        using acc = typename SumOf<T>::type;
+        static inline vec load(const T* p)          { return *p; }
+        static inline vec set1(T x)                 { return x; }
+        static inline uint64_t eq(vec a, vec b)     { return a == b; }
+        static inline uint64_t gt(vec a, vec b)     { return a > b; }
+        static inline vec min(vec x, vec acc)       { return (x < acc || acc != acc) ? x : acc; }
+        static inline vec max(vec x, vec acc)       { return (x > acc || acc != acc) ? x : acc; }
+        static inline void store(T* p, vec a)       { *p = a; }
+        static inline acc acc_zero()                { return 0; }
+        static inline acc acc_add(acc a, vec b)     { return a + b; }
+        static inline acc acc_reduce(acc a)         { return a; }
+    };
+
+    namespace scalar {
+        template <typename T> using Ops = ScalarOps<T>;
+#include "virtual_vec_simd_kernels.inc"
+    }
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+    template <typename T> struct Avx2Ops;
+
+    template <>
+    struct Avx2Ops<int32_t> {
+        static constexpr size_t lanes = 8;
+        static constexpr size_t bytes = 32;
+        using vec = __m256i;
+        using acc = __m256i;
+        static inline vec load(const int32_t* p)    { return _mm256_load_si256(reinterpret_cast<const __m256i*>(p)); }
+        static inline vec set1(int32_t x)           { return _mm256_set1_epi32(x); }
+        static inline uint64_t eq(vec a, vec b)     { return uint32_t(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)))); }
+        static inline uint64_t gt(vec a, vec b)     { return uint32_t(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(a, b)))); }
+        static inline vec min(vec a, vec b)         { return _mm256_min_epi32(a, b); }
+        static inline vec max(vec a, vec b)         { return _mm256_max_epi32(a, b); }
+        static inline void store(int32_t* p, vec a) { _mm256_store_si256(reinterpret_cast<__m256i*>(p), a); }
+        static inline acc acc_zero()                { return _mm256_setzero_si256(); }
+        static inline acc acc_add(acc a, vec b) {
+            a = _mm256_add_epi64(a, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(b)));
+            return _mm256_add_epi64(a, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(b, 1)));
+        }
+        static inline int64_t acc_reduce(acc a) {
+            alignas(32) int64_t lanes[4];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), a);
+            return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        }
+    };
+
+    template <>
+    struct Avx2Ops<int64_t> {
+        static constexpr size_t lanes = 4;
+        static constexpr size_t bytes = 32;
+        using vec = __m256i;
+        using acc = __m256i;
+        static inline vec load(const int64_t* p)    { return _mm256_load_si256(reinterpret_cast<const __m256i*>(p)); }
+        static inline vec set1(int64_t x)           { return _mm256_set1_epi64x(x); }
+        static inline uint64_t eq(vec a, vec b)     { return uint32_t(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(a, b)))); }
+        static inline uint64_t gt(vec a, vec b)     { return uint32_t(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(a, b)))); }
+        // AVX2 has no 64-bit min/max, so blend on a comparison instead.
+        static inline vec min(vec a, vec b)         { return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b)); }
+        static inline vec max(vec a, vec b)         { return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b)); }
+        static inline void store(int64_t* p, vec a) { _mm256_store_si256(reinterpret_cast<__m256i*>(p), a); }
+        static inline acc acc_zero()                { return _mm256_setzero_si256(); }
+        static inline acc acc_add(acc a, vec b)     { return _mm256_add_epi64(a, b); }
+        static inline int64_t acc_reduce(acc a) {
+            alignas(32) int64_t lanes[4];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), a);
+            return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        }
+    };
+
+    template <>
+    struct Avx2Ops<float> {
+        static constexpr size_t lanes = 8;
+        static constexpr size_t bytes = 32;
+        using vec = __m256;
+        using acc = __m256d;
+        static inline vec load(const float* p)      { return _mm256_load_ps(p); }
+        static inline vec set1(float x)             { return _mm256_set1_ps(x); }
+        static inline uint64_t eq(vec a, vec b)     { return uint32_t(_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ))); }
+        static inline uint64_t gt(vec a, vec b)     { return uint32_t(_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_GT_OQ))); }
+        // minps/maxps return the second operand when either is NaN, which
+        // keeps acc over a NaN x. A NaN acc is replaced by x.
+        static inline vec min(vec x, vec acc)       { return _mm256_blendv_ps(_mm256_min_ps(x, acc), x, _mm256_cmp_ps(acc, acc, _CMP_UNORD_Q)); }
+        static inline vec max(vec x, vec acc)       { return _mm256_blendv_ps(_mm256_max_ps(x, acc), x, _mm256_cmp_ps(acc, acc, _CMP_UNORD_Q)); }
+        static inline void store(float* p, vec a)   { _mm256_store_ps(p, a); }
+        static inline acc acc_zero()                { return _mm256_setzero_pd(); }
+        static inline acc acc_add(acc a, vec b) {
+            a = _mm256_add_pd(a, _mm256_cvtps_pd(_mm256_castps256_ps128(b)));
+            return _mm256_add_pd(a, _mm256_cvtps_pd(_mm256_extractf128_ps(b, 1)));
+        }
+        static inline double acc_reduce(acc a) {
+            alignas(32) double lanes[4];
+            _mm256_store_pd(lanes, a);
+            return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        }
+    };
+
+    namespace avx2 {
+        template <typename T> using Ops = Avx2Ops<T>;
+#include "virtual_vec_simd_kernels.inc"
+    }
+
+#pragma GCC pop_options
+
+// GCC's AVX-512 headers trip a -Wmaybe-uninitialized false positive.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+
+    template <typename T> struct Avx512Ops;
+
+    template <>
+    struct Avx512Ops<int32_t> {
+        static constexpr size_t lanes = 16;
+        static constexpr size_t bytes = 64;
+        using vec = __m512i;
+        using acc = __m512i;
+        static inline vec load(const int32_t* p)    { return _mm512_load_si512(p); }
+        static inline vec set1(int32_t x)           { return _mm512_set1_epi32(x); }
+        static inline uint64_t eq(vec a, vec b)     { return _mm512_cmpeq_epi32_mask(a, b); }
+        static inline uint64_t gt(vec a, vec b)     { return _mm512_cmpgt_epi32_mask(a, b); }
+        static inline vec min(vec a, vec b)         { return _mm512_min_epi32(a, b); }
+        static inline vec max(vec a, vec b)         { return _mm512_max_epi32(a, b); }
+        static inline void store(int32_t* p, vec a) { _mm512_store_si512(p, a); }
+        static inline acc acc_zero()                { return _mm512_setzero_si512(); }
+        static inline acc acc_add(acc a, vec b) {
+            a = _mm512_add_epi64(a, _mm512_cvtepi32_epi64(_mm512_castsi512_si256(b)));
+            return _mm512_add_epi64(a, _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(b, 1)));
+        }
+        static inline int64_t acc_reduce(acc a)     { return _mm512_reduce_add_epi64(a); }
+    };
+
+    template <>
+    struct Avx512Ops<int64_t> {
+        static constexpr size_t lanes = 8;
+        static constexpr size_t bytes = 64;
+        using vec = __m512i;
+        using acc = __m512i;
+        static inline vec load(const int64_t* p)    { return _mm512_load_si512(p); }
+        static inline vec set1(int64_t x)           { return _mm512_set1_epi64(x); }
+        static inline uint64_t eq(vec a, vec b)     { return _mm512_cmpeq_epi64_mask(a, b); }
+        static inline uint64_t gt(vec a, vec b)     { return _mm512_cmpgt_epi64_mask(a, b); }
+        static inline vec min(vec a, vec b)         { return _mm512_min_epi64(a, b); }
+        static inline vec max(vec a, vec b)         { return _mm512_max_epi64(a, b); }
+        static inline void store(int64_t* p, vec a) { _mm512_store_si512(p, a); }
+        static inline acc acc_zero()                { return _mm512_setzero_si512(); }
+        static inline acc acc_add(acc a, vec b)     { return _mm512_add_epi64(a, b); }
+        static inline int64_t acc_reduce(acc a)     { return _mm512_reduce_add_epi64(a); }
+    };
+
+    template <>
+    struct Avx512Ops<float> {
+        static constexpr size_t lanes = 16;
+        static constexpr size_t bytes = 64;
+        using vec = __m512;
+        using acc = __m512d;
+        static inline vec load(const float* p)      { return _mm512_load_ps(p); }
+        static inline vec set1(float x)             { return _mm512_set1_ps(x); }
+        static inline uint64_t eq(vec a, vec b)     { return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ); }
+        static inline uint64_t gt(vec a, vec b)     { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+        // Same NaN handling as Avx2Ops<float>.
+        static inline vec min(vec x, vec acc)       { return _mm512_mask_mov_ps(_mm512_min_ps(x, acc), _mm512_cmp_ps_mask(acc, acc, _CMP_UNORD_Q), x); }
+        static inline vec max(vec x, vec acc)       { return _mm512_mask_mov_ps(_mm512_max_ps(x, acc), _mm512_cmp_ps_mask(acc, acc, _CMP_UNORD_Q), x); }
+        static inline void store(float* p, vec a)   { _mm512_store_ps(p, a); }
+        static inline acc acc_zero()                { return _mm512_setzero_pd(); }
+        static inline acc acc_add(acc a, vec b) {
+            a = _mm512_add_pd(a, _mm512_cvtps_pd(_mm512_castps512_ps256(b)));
+            __m256 high = _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(b), 1));
+            return _mm512_add_pd(a, _mm512_cvtps_pd(high));
+        }
+        static inline double acc_reduce(acc a)      { return _mm512_reduce_add_pd(a); }
+    };
+
+    namespace avx512 {
+        template <typename T> using Ops = Avx512Ops<T>;
+#include "virtual_vec_simd_kernels.inc"
+    }
+
+#pragma GCC pop_options
+#pragma GCC diagnostic pop
+
+    simd_level detect_level() {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) { return simd_level::avx512; }
+        if (__builtin_cpu_supports("avx2")) { return simd_level::avx2; }
+        return simd_level::scalar;
+    }
+
+    simd_level& active_level() {
+        static simd_level level = detect_level();
+        return level;
+    }
+
+#define VV_SIMD_DISPATCH(NAME, ...)                                                                          \
+    switch (active_level()) {                                                                                \
+        case simd_level::avx512: return avx512::NAME(__VA_ARGS__);                                           \
+        case simd_level::avx2:   return avx2::NAME(__VA_ARGS__);                                             \
+        default:                 return scalar::NAME(__VA_ARGS__);                                           \
+    }
+
+    template <typename T>
+    const T* dispatch_find(const T* first, const T* last, T value) {
+        VV_SIMD_DISPATCH(find, first, last, value)
+    }
+
+    template <typename T>
+    size_t dispatch_count(const T* first, const T* last, T value) {
+        VV_SIMD_DISPATCH(count, first, last, value)
+    }
+
+    template <typename T>
+    T dispatch_min(const T* first, const T* last) {
+        VV_SIMD_DISPATCH(minmax<true>, first, last)
+    }
+
+    template <typename T>
+    T dispatch_max(const T* first, const T* last) {
+        VV_SIMD_DISPATCH(minmax<false>, first, last)
+    }
+
+    template <typename T>
+    typename SumOf<T>::type dispatch_sum(const T* first, const T* last) {
+        VV_SIMD_DISPATCH(sum, first, last)
+    }
+
+    template <typename T>
+    void dispatch_filter_greater(const T* first, const T* last, T threshold, virtual_vec<uint32_t>& out) {
+        VV_SIMD_DISPATCH(filter_greater, first, last, threshold, out)
+    }
+
+#undef VV_SIMD_DISPATCH
+
+    // Splits [first, last) into one chunk per thread, reduces each chunk with
+    // kernel and folds the partial results with combine.
+    template <typename T, typename Kernel, typename Combine>
+    auto parallel_reduce(const T* first, const T* last, unsigned threads, Kernel kernel, Combine combine) {
+        size_t n = last - first;
+        // Every chunk gets at least one element, and small ranges stay on the
+        // calling thread.
+        threads = unsigned(std::min<size_t>(threads, n / simd_parallel_threshold() + 1));
+        if (threads <= 1) {
+            return kernel(first, last);
+        }
+        using Result = decltype(kernel(first, last));
+        std::vector<Result> partials(threads);
+        std::vector<std::thread> workers;
+        auto chunk = [&](unsigned i) { return first + n * i / threads; };
+        try {
+            for (unsigned i = 1; i < threads; i++) {
+                workers.emplace_back([&partials, &kernel, begin = chunk(i), end = chunk(i + 1), i]() {
+                    partials[i] = kernel(begin, end);
+                });
+            }
+        } catch (...) {
+            for (auto& worker : workers) worker.join();
+            throw;
+        }
+        partials[0] = kernel(first, chunk(1));
+        for (auto& worker : workers) worker.join();
+        Result result = partials[0];
+        for (unsigned i = 1; i < threads; i++) result = combine(result, partials[i]);
+        return result;
+    }
+};
+
+simd_level simd_detected_level() {
+    static simd_level level = detect_level();
+    return level;
+}
+
+simd_level simd_active_level() {
+    return active_level();
+}
+
+void simd_set_level(simd_level level) {
+    active_level() = std::min(level, simd_detected_level());
+}
+
+#define VV_SIMD_DEFINE(T)                                                                                \
+    const T* simd_find(const T* first, const T* last, T value) {                                         \
+        return dispatch_find(first, last, value);                                                        \
+    }                                                                                                    \
+    size_t simd_count(const T* first, const T* last, T value, unsigned threads) {                        \
+        return parallel_reduce(first, last, threads,                                                     \
+            [value](const T* f, const T* l) { return dispatch_count(f, l, value); },                     \
+            [](size_t a, size_t b) { return a + b; });                                                   \
+    }                                                                                                    \
+    T simd_min(const T* first, const T* last, unsigned threads) {                                        \
+        return parallel_reduce(first, last, threads, dispatch_min<T>,                                    \
+            [](T a, T b) { return (b < a || a != a) ? b : a; });                                         \
+    }                                                                                                    \
+    T simd_max(const T* first, const T* last, unsigned threads) {                                        \
+        return parallel_reduce(first, last, threads, dispatch_max<T>,                                    \
+            [](T a, T b) { return (b > a || a != a) ? b : a; });                                         \
+    }                                                                                                    \
+    SumOf<T>::type simd_sum(const T* first, const T* last, unsigned threads) {                           \
+        using S = SumOf<T>::type;                                                                        \
+        return parallel_reduce(first, last, threads, dispatch_sum<T>, [](S a, S b) { return a + b; });   \
+    }                                                                                                    \
+    void simd_filter_greater(const T* first, const T* last, T threshold, virtual_vec<uint32_t>& out) {   \
+        if (size_t(last - first) > UINT32_MAX) {                                                         \
+            throw std::out_of_range("Range too large for 32-bit indices");                               \
+        }                                                                                                \
+        dispatch_filter_greater(first, last, threshold, out);                                            \
+    }
+
+VV_SIMD_DEFINE(int32_t)
+VV_SIMD_DEFINE(int64_t)
+VV_SIMD_DEFINE(float)
+
+#undef VV_SIMD_DEFINE
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "virtual_vec.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Search and reduction kernels over contiguous ranges, typically the
+// [begin(), end()) of a virtual_vec. The widest instruction set the CPU
+// supports (AVX-512, AVX2 or plain scalar code) is picked at runtime.
+//
+// The reductions (count, min, max, sum) take an optional number of threads.
+// Ranges smaller than simd_parallel_threshold() are always scanned on the
+// calling thread.
+
+enum class simd_level {
+    scalar,
+    avx2,
+    avx512,
+};
+
+// Best level supported by this CPU.
+simd_level simd_detected_level();
+// Level currently used by the kernels.
+simd_level simd_active_level();
+// Forces the kernels to use level, clamped to simd_detected_level(). Meant for
+// tests and benchmarks.
+void simd_set_level(simd_level level);
+
+// Number of elements below which the reductions ignore their threads argument.
+inline size_t simd_parallel_threshold() { return 1 << 20; }
+
+// Returns a pointer to the first element equal to value, or last.
+const int32_t* simd_find(const int32_t* first, const int32_t* last, int32_t value);
+const int64_t* simd_find(const int64_t* first, const int64_t* last, int64_t value);
+const float*   simd_find(const float* first, const float* last, float value);
+
+size_t simd_count(const int32_t* first, const int32_t* last, int32_t value, unsigned threads = 1);
+size_t simd_count(const int64_t* first, const int64_t* last, int64_t value, unsigned threads = 1);
+size_t simd_count(const float* first, const float* last, float value, unsigned threads = 1);
+
+// The range must not be empty. NaN elements are skipped, so the result is NaN
+// only if every element is NaN.
+int32_t simd_min(const int32_t* first, const int32_t* last, unsigned threads = 1);
+int64_t simd_min(const int64_t* first, const int64_t* last, unsigned threads = 1);
+float   simd_min(const float* first, const float* last, unsigned threads = 1);
+int32_t simd_max(const int32_t* first, const int32_t* last, unsigned threads = 1);
+int64_t simd_max(const int64_t* first, const int64_t* last, unsigned threads = 1);
+float   simd_max(const float* first, const float* last, unsigned threads = 1);
+
+// Sums are accumulated in a wider type so large int32 columns do not overflow.
+// Float sums are accumulated in double, in a different order than
+// std::accumulate, so results may differ in the last bits.
+int64_t simd_sum(const int32_t* first, const int32_t* last, unsigned threads = 1);
+int64_t simd_sum(const int64_t* first, const int64_t* last, unsigned threads = 1);
+double  simd_sum(const float* first, const float* last, unsigned threads = 1);
+
+// Appends to out the index (relative to first) of every element greater than
+// threshold. Indices are 32 bits wide, which always suffices for a virtual_vec
+// (at most 4GB of 4-byte or wider elements). Throws std::out_of_range if the
+// range has more than UINT32_MAX elements.
+void simd_filter_greater(const int32_t* first, const int32_t* last, int32_t threshold, virtual_vec<uint32_t>& out);
+void simd_filter_greater(const int64_t* first, const int64_t* last, int64_t threshold, virtual_vec<uint32_t>& out);
+void simd_filter_greater(const float* first, const float* last, float threshold, virtual_vec<uint32_t>& out);
+
+template <typename T>
+inline typename virtual_vec<T>::const_iterator simd_find(const virtual_vec<T>& v, std::type_identity_t<T> value) {
+    return simd_find(v.cbegin(), v.cend(), value);
+}
+
+template <typename T>
+inline size_t simd_count(const virtual_vec<T>& v, std::type_identity_t<T> value, unsigned threads = 1) {
+    return simd_count(v.cbegin(), v.cend(), value, threads);
+}
+
+template <typename T>
+inline T simd_min(const virtual_vec<T>& v, unsigned threads = 1) {
+    return simd_min(v.cbegin(), v.cend(), threads);
+}
+
+template <typename T>
+inline T simd_max(const virtual_vec<T>& v, unsigned threads = 1) {
+    return simd_max(v.cbegin(), v.cend(), threads);
+}
+
+template <typename T>
+inline auto simd_sum(const virtual_vec<T>& v, unsigned threads = 1) {
+    return simd_sum(v.cbegin(), v.cend(), threads);
+}
+
+template <typename T>
+inline void simd_filter_greater(const virtual_vec<T>& v, std::type_identity_t<T> threshold, virtual_vec<uint32_t>& out) {
+    simd_filter_greater(v.cbegin(), v.cend(), threshold, out);
+}